@@ -0,0 +1,711 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "indexer.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <unistd.h>
+
+namespace stake_indexer {
+
+// "STKIDX" followed by the two digit format version
+static constexpr char     checkpoint_magic[8] = { 'S', 'T', 'K', 'I', 'D', 'X', '0', '3' };
+static constexpr size_t   checkpoint_tag_size = 6;
+static constexpr int64_t  max_amount          = ( 1LL << 62 ) - 1;
+
+std::string name_to_string( uint64_t value )
+{
+   static const char* charmap = ".12345abcdefghijklmnopqrstuvwxyz";
+   std::string str( 13, '.' );
+   uint64_t tmp = value;
+   for( uint32_t i = 0; i <= 12; ++i ) {
+      char c = charmap[tmp & ( i == 0 ? 0x0f : 0x1f )];
+      str[12 - i] = c;
+      tmp >>= ( i == 0 ? 4 : 5 );
+   }
+   auto last = str.find_last_not_of( '.' );
+   str.resize( last == std::string::npos ? 0 : last + 1 );
+   return str;
+}
+
+uint64_t string_to_symbol_code( std::string_view str )
+{
+   check( !str.empty() && str.size() <= 7, "invalid symbol code" );
+   uint64_t value = 0;
+   for( auto itr = str.rbegin(); itr != str.rend(); ++itr ) {
+      check( *itr >= 'A' && *itr <= 'Z', "invalid symbol code" );
+      value <<= 8;
+      value |= static_cast<uint64_t>( *itr );
+   }
+   return value;
+}
+
+std::string symbol_code_to_string( uint64_t value )
+{
+   std::string str;
+   for( ; value != 0; value >>= 8 ) {
+      str += static_cast<char>( value & 0xff );
+   }
+   return str;
+}
+
+asset string_to_asset( std::string_view str )
+{
+   auto space = str.find( ' ' );
+   check( space != std::string_view::npos, "invalid asset" );
+
+   asset a;
+   bool negative = false;
+   bool fraction = false;
+   std::string_view amount = str.substr( 0, space );
+   for( size_t i = 0; i < amount.size(); ++i ) {
+      char c = amount[i];
+      if( i == 0 && c == '-' ) {
+         negative = true;
+      } else if( c == '.' && !fraction ) {
+         fraction = true;
+      } else {
+         check( c >= '0' && c <= '9', "invalid asset amount" );
+         check( a.amount <= ( max_amount - ( c - '0' ) ) / 10, "asset amount overflow" );
+         a.amount = a.amount * 10 + ( c - '0' );
+         if( fraction ) ++a.precision;
+      }
+   }
+   if( negative ) a.amount = -a.amount;
+   a.sym_code = string_to_symbol_code( str.substr( space + 1 ) );
+   return a;
+}
+
+std::string asset_to_string( int64_t amount, uint64_t sym_code, uint8_t precision )
+{
+   bool negative = amount < 0;
+   uint64_t abs_amount = negative ? -static_cast<uint64_t>( amount ) : amount;
+   std::string digits = std::to_string( abs_amount );
+   if( precision > 0 ) {
+      if( digits.size() <= precision ) digits.insert( 0, precision + 1 - digits.size(), '0' );
+      digits.insert( digits.size() - precision, 1, '.' );
+   }
+   return ( negative ? "-" : "" ) + digits + " " + symbol_code_to_string( sym_code );
+}
+
+
+balance_store::balance_store()
+{
+   clear();
+}
+
+void balance_store::clear()
+{
+   _slots.assign( 1024, slot{} );
+   _mask = _slots.size() - 1;
+   _size = 0;
+}
+
+size_t balance_store::bucket( uint64_t owner, uint64_t sym_code )const
+{
+   // names are packed from the high bits, so the low bits must be mixed in from above
+   uint64_t h = owner ^ ( sym_code * 0x9e3779b97f4a7c15ULL );
+   h ^= h >> 33;
+   h *= 0xff51afd7ed558ccdULL;
+   h ^= h >> 33;
+   h *= 0xc4ceb9fe1a85ec53ULL;
+   h ^= h >> 33;
+   return static_cast<size_t>( h ) & _mask;
+}
+
+const balance_row* balance_store::find( uint64_t owner, uint64_t sym_code )const
+{
+   for( size_t i = bucket( owner, sym_code ); _slots[i].sym_code != 0; i = ( i + 1 ) & _mask ) {
+      if( _slots[i].owner == owner && _slots[i].sym_code == sym_code ) return &_slots[i].row;
+   }
+   return nullptr;
+}
+
+balance_row* balance_store::find( uint64_t owner, uint64_t sym_code )
+{
+   return const_cast<balance_row*>( static_cast<const balance_store*>( this )->find( owner, sym_code ) );
+}
+
+balance_row& balance_store::emplace( uint64_t owner, uint64_t sym_code, uint8_t precision )
+{
+   // keep load factor under 1/2
+   if( ( _size + 1 ) * 2 > _slots.size() ) grow();
+
+   size_t i = bucket( owner, sym_code );
+   for( ; _slots[i].sym_code != 0; i = ( i + 1 ) & _mask ) {
+      if( _slots[i].owner == owner && _slots[i].sym_code == sym_code ) return _slots[i].row;
+   }
+   _slots[i].owner = owner;
+   _slots[i].sym_code = sym_code;
+   _slots[i].row = balance_row{};
+   _slots[i].row.precision = precision;
+   ++_size;
+   return _slots[i].row;
+}
+
+bool balance_store::erase( uint64_t owner, uint64_t sym_code )
+{
+   size_t i = bucket( owner, sym_code );
+   for( ; _slots[i].sym_code != 0; i = ( i + 1 ) & _mask ) {
+      if( _slots[i].owner == owner && _slots[i].sym_code == sym_code ) break;
+   }
+   if( _slots[i].sym_code == 0 ) return false;
+
+   // shift following entries of the probe chain back into the hole
+   size_t hole = i;
+   for( size_t j = ( i + 1 ) & _mask; _slots[j].sym_code != 0; j = ( j + 1 ) & _mask ) {
+      size_t home = bucket( _slots[j].owner, _slots[j].sym_code );
+      if( ( ( j - home ) & _mask ) >= ( ( j - hole ) & _mask ) ) {
+         _slots[hole] = _slots[j];
+         hole = j;
+      }
+   }
+   _slots[hole] = slot{};
+   --_size;
+   return true;
+}
+
+void balance_store::grow()
+{
+   std::vector<slot> old( _slots.size() * 2 );
+   old.swap( _slots );
+   _mask = _slots.size() - 1;
+   for( const auto& s : old ) {
+      if( s.sym_code == 0 ) continue;
+      size_t i = bucket( s.owner, s.sym_code );
+      while( _slots[i].sym_code != 0 ) i = ( i + 1 ) & _mask;
+      _slots[i] = s;
+   }
+}
+
+
+/*
+ * Trace line format, fields separated by '\t':
+ *    global_sequence  block_time_sec  action  data...
+ * data fields follow the action's ABI order, a trailing memo takes the rest of the line,
+ * a name[] is written as a comma separated list.
+ */
+bool state::apply_line( std::string_view line )
+{
+   if( line.empty() || line[0] == '#' ) return false;
+   if( line.back() == '\r' ) line.remove_suffix( 1 );
+
+   // at most 4 data fields, the last one keeps any tabs of a memo
+   std::string_view fields[7];
+   size_t n = 0;
+   size_t pos = 0;
+   while( n < 6 ) {
+      auto tab = line.find( '\t', pos );
+      if( tab == std::string_view::npos ) break;
+      fields[n++] = line.substr( pos, tab - pos );
+      pos = tab + 1;
+   }
+   fields[n++] = line.substr( pos );
+   check( n >= 3, "malformed trace line" );
+
+   auto to_uint = []( std::string_view s ) {
+      check( !s.empty(), "invalid integer" );
+      uint64_t v = 0;
+      for( char c : s ) {
+         check( c >= '0' && c <= '9', "invalid integer" );
+         check( v <= ( UINT64_MAX - ( c - '0' ) ) / 10, "integer overflow" );
+         v = v * 10 + ( c - '0' );
+      }
+      return v;
+   };
+   auto to_name = []( std::string_view s ) { return string_to_name( s ); };
+   // "4,ADD"
+   auto to_symbol = [&]( std::string_view s, uint8_t& precision ) {
+      auto comma = s.find( ',' );
+      check( comma != std::string_view::npos, "invalid symbol" );
+      precision = static_cast<uint8_t>( to_uint( s.substr( 0, comma ) ) );
+      return string_to_symbol_code( s.substr( comma + 1 ) );
+   };
+   auto need = [&]( size_t count ) {
+      check( n >= 3 + count, "missing action data" );
+   };
+
+   uint64_t seq = to_uint( fields[0] );
+   if( seq <= _last_seq ) return false;
+   uint32_t block_time = static_cast<uint32_t>( to_uint( fields[1] ) );
+   const auto* data = fields + 3;
+   uint8_t precision = 0;
+
+   switch( string_to_name( fields[2] ) ) {
+      case string_to_name( "create" ):
+         need( 2 );
+         create( to_name( data[0] ), string_to_asset( data[1] ) );
+         break;
+      case string_to_name( "issue" ):
+         need( 2 );
+         issue( string_to_asset( data[1] ) );
+         break;
+      case string_to_name( "retire" ):
+         need( 1 );
+         retire( string_to_asset( data[0] ) );
+         break;
+      case string_to_name( "setdelay" ):
+         need( 2 );
+         setdelay( to_symbol( data[0], precision ), to_uint( data[1] ) );
+         break;
+      case string_to_name( "settransfee" ):
+         need( 3 );
+         settransfee( to_symbol( data[0], precision ), to_uint( data[1] ), to_name( data[2] ) );
+         break;
+      case string_to_name( "setreclaim" ):
+         need( 2 );
+         setreclaim( to_symbol( data[0], precision ), data[1] == "1" || data[1] == "true" );
+         break;
+      case string_to_name( "transfer" ):
+         need( 4 );
+         transfer( to_name( data[0] ), to_name( data[1] ), string_to_asset( data[2] ), data[3] );
+         break;
+      case string_to_name( "stake" ):
+      case string_to_name( "autostake" ):
+         need( 2 );
+         stake( to_name( data[0] ), string_to_asset( data[1] ) );
+         break;
+      case string_to_name( "unstake" ):
+         need( 2 );
+         unstake( to_name( data[0] ), string_to_asset( data[1] ), block_time );
+         break;
+      case string_to_name( "refund" ):
+         need( 3 );
+         refund( to_name( data[1] ), to_uint( data[2] ) );
+         break;
+      case string_to_name( "autorefund" ):
+         need( 2 );
+         refund( to_name( data[0] ), to_uint( data[1] ) );
+         break;
+      case string_to_name( "cancelunstake" ):
+         need( 2 );
+         cancelunstake( to_name( data[0] ), to_uint( data[1] ) );
+         break;
+      case string_to_name( "open" ): {
+         need( 2 );
+         uint64_t sym_code = to_symbol( data[1], precision );
+         open( to_name( data[0] ), sym_code, precision );
+         break;
+      }
+      case string_to_name( "close" ):
+         need( 2 );
+         close( to_name( data[0] ), to_symbol( data[1], precision ) );
+         break;
+      case string_to_name( "gc" ):
+         need( 2 );
+         gc( to_symbol( data[0], precision ), data[1] );
+         break;
+      default:
+         // addblacklist, rmblacklist and anything else do not touch balances
+         break;
+   }
+
+   _last_seq = seq;
+   return true;
+}
+
+currency_stats& state::get_stats_mutable( uint64_t sym_code )
+{
+   auto itr = _stats.find( sym_code );
+   check( itr != _stats.end(), "symbol does not exist" );
+   return itr->second;
+}
+
+void state::create( uint64_t issuer, const asset& maximum_supply )
+{
+   check( _stats.find( maximum_supply.sym_code ) == _stats.end(), "token with symbol already exists" );
+
+   auto& s = _stats[maximum_supply.sym_code];
+   s.max_supply   = maximum_supply.amount;
+   s.precision    = maximum_supply.precision;
+   s.issuer       = issuer;
+   s.fee_receiver = issuer;
+}
+
+void state::issue( const asset& quantity )
+{
+   auto& st = get_stats_mutable( quantity.sym_code );
+   check( quantity.amount <= st.max_supply - st.supply, "quantity exceeds available supply" );
+
+   st.supply += quantity.amount;
+   add_balance( st.issuer, quantity );
+   // the transfer to 'to' shows up as its own inline trace
+}
+
+void state::retire( const asset& quantity )
+{
+   auto& st = get_stats_mutable( quantity.sym_code );
+   sub_balance( st.issuer, quantity );
+   st.supply -= quantity.amount;
+}
+
+void state::setdelay( uint64_t sym_code, uint64_t t )
+{
+   get_stats_mutable( sym_code ).refund_delay = t;
+}
+
+void state::settransfee( uint64_t sym_code, uint64_t r, uint64_t receiver )
+{
+   auto& st = get_stats_mutable( sym_code );
+   st.transfer_fee_ratio = r;
+   st.fee_receiver = receiver;
+}
+
+void state::setreclaim( uint64_t sym_code, bool enabled )
+{
+   get_stats_mutable( sym_code ).auto_reclaim = enabled;
+}
+
+void state::transfer( uint64_t from, uint64_t to, const asset& quantity, std::string_view memo )
+{
+   auto separator_pos = memo.find( ':' );
+   if( separator_pos != std::string_view::npos ) {
+      auto main_memo = memo.substr( 0, separator_pos );
+      auto sub_memo = memo.substr( separator_pos + 1 );
+
+      // FromLiquidToStaked moves liquid tokens, the autostake follows as an inline trace
+      if( main_memo == "Transfer" && sub_memo == "FromStakedToLiquid" ) {
+         return transfer_staked_to_liquid( from, to, quantity );
+      }
+   }
+
+   sub_balance( from, quantity );
+   add_balance( to, quantity );
+}
+
+void state::transfer_staked_to_liquid( uint64_t from, uint64_t to, const asset& quantity )
+{
+   auto* lock_from = _balances.find( from, quantity.sym_code );
+   check( lock_from != nullptr, "no balance object found in lock_accounts" );
+
+   const auto& st = get_stats_mutable( quantity.sym_code );
+   // same bound as asset::operator*, the chain rejects a product above max_amount
+   int64_t ratio = static_cast<int64_t>( st.transfer_fee_ratio );
+   check( ratio == 0 || quantity.amount <= max_amount / ratio, "multiplication overflow" );
+   int64_t transfer_fee = quantity.amount * ratio / 100;
+   transfer_fee = ( transfer_fee < 1 ) ? 1 : transfer_fee;
+   check( lock_from->locked >= quantity.amount + lock_from->unstaking + transfer_fee, "transfer_staked_to_liquid overdrawn balance" );
+
+   sub_balance( from, quantity, true );
+   add_balance( to, quantity );
+
+   // 'to' may share the probe chain, look 'from' up again after add_balance
+   _balances.find( from, quantity.sym_code )->locked -= quantity.amount + transfer_fee;
+   // the fee transfer to fee_receiver shows up as its own inline trace
+}
+
+void state::stake( uint64_t owner, const asset& quantity )
+{
+   auto* from = _balances.find( owner, quantity.sym_code );
+   check( from != nullptr, "no balance object found" );
+   check( from->balance >= from->locked + quantity.amount, "overdrawn balance for stake action" );
+
+   from->locked += quantity.amount;
+}
+
+void state::unstake( uint64_t owner, const asset& quantity, uint32_t block_time )
+{
+   auto* lock_from = _balances.find( owner, quantity.sym_code );
+   check( lock_from != nullptr, "no balance object found" );
+   check( lock_from->locked >= lock_from->unstaking + quantity.amount, "overdrawn locked balance" );
+
+   const auto& st = get_stats_mutable( quantity.sym_code );
+
+   // refunds are scoped by owner only, index is available_primary_key() across all symbols
+   auto& reqs = _refunds[owner];
+   uint64_t auto_index = reqs.empty() ? 0 : reqs.back().index + 1;
+   reqs.push_back( refund_request{ auto_index, static_cast<uint32_t>( block_time + st.refund_delay ), quantity.amount, quantity.sym_code } );
+
+   lock_from->unstaking += quantity.amount;
+}
+
+void state::refund( uint64_t owner, uint64_t index )
+{
+   auto reqs = _refunds.find( owner );
+   check( reqs != _refunds.end(), "refund request not found" );
+   auto req = std::lower_bound( reqs->second.begin(), reqs->second.end(), index,
+                                []( const refund_request& r, uint64_t i ) { return r.index < i; } );
+   check( req != reqs->second.end() && req->index == index, "refund request not found" );
+
+   auto* lock_from = _balances.find( owner, req->sym_code );
+   check( lock_from != nullptr, "no balance object found" );
+   check( lock_from->locked >= req->amount, "overdrawn locked balance" );
+
+   lock_from->locked -= req->amount;
+   lock_from->unstaking -= req->amount;
+
+   reqs->second.erase( req );
+   if( reqs->second.empty() ) _refunds.erase( reqs );
+}
+
+void state::cancelunstake( uint64_t owner, uint64_t index )
+{
+   auto reqs = _refunds.find( owner );
+   check( reqs != _refunds.end(), "refund request not found" );
+   auto req = std::lower_bound( reqs->second.begin(), reqs->second.end(), index,
+                                []( const refund_request& r, uint64_t i ) { return r.index < i; } );
+   check( req != reqs->second.end() && req->index == index, "refund request not found" );
+
+   if( auto* lock_from = _balances.find( owner, req->sym_code ) ) {
+      lock_from->unstaking -= req->amount;
+   }
+
+   reqs->second.erase( req );
+   if( reqs->second.empty() ) _refunds.erase( reqs );
+}
+
+void state::open( uint64_t owner, uint64_t sym_code, uint8_t precision )
+{
+   _balances.emplace( owner, sym_code, precision );
+}
+
+void state::close( uint64_t owner, uint64_t sym_code )
+{
+   const auto* row = _balances.find( owner, sym_code );
+   check( row != nullptr, "Balance row already deleted or never existed." );
+   check( row->balance == 0 && row->locked == 0, "Cannot close because the balance is not zero." );
+   _balances.erase( owner, sym_code );
+}
+
+void state::gc( uint64_t sym_code, std::string_view owners )
+{
+   check( get_stats_mutable( sym_code ).auto_reclaim, "symbol has not opted in to reclaim, call setreclaim first." );
+   while( !owners.empty() ) {
+      auto comma = owners.find( ',' );
+      erase_empty_rows( string_to_name( owners.substr( 0, comma ) ), sym_code );
+      owners.remove_prefix( comma == std::string_view::npos ? owners.size() : comma + 1 );
+   }
+}
+
+void state::erase_empty_rows( uint64_t owner, uint64_t sym_code )
+{
+   const auto* row = _balances.find( owner, sym_code );
+   if( row != nullptr && row->balance == 0 && row->locked == 0 ) {
+      _balances.erase( owner, sym_code );
+   }
+}
+
+void state::sub_balance( uint64_t owner, const asset& value, bool use_locked_balance )
+{
+   auto* from = _balances.find( owner, value.sym_code );
+   check( from != nullptr, "no balance object found in accounts" );
+
+   if( use_locked_balance ) {
+      check( from->locked >= value.amount, "sub_balance: lock_from.locked_balanc overdrawn balance" );
+   } else {
+      check( from->balance >= value.amount + from->locked, "sub_balance: from.balance overdrawn balance" );
+   }
+
+   from->balance -= value.amount;
+
+   if( from->balance == 0 && from->locked == 0 && get_stats_mutable( value.sym_code ).auto_reclaim ) {
+      _balances.erase( owner, value.sym_code );
+   }
+}
+
+void state::add_balance( uint64_t owner, const asset& value )
+{
+   _balances.emplace( owner, value.sym_code, value.precision ).balance += value.amount;
+}
+
+const balance_row* state::get_balance( uint64_t owner, uint64_t sym_code )const
+{
+   return _balances.find( owner, sym_code );
+}
+
+const currency_stats* state::get_stats( uint64_t sym_code )const
+{
+   auto itr = _stats.find( sym_code );
+   return itr == _stats.end() ? nullptr : &itr->second;
+}
+
+const std::vector<refund_request>* state::get_refunds( uint64_t owner )const
+{
+   auto itr = _refunds.find( owner );
+   return itr == _refunds.end() ? nullptr : &itr->second;
+}
+
+
+/*
+ * Checkpoint layout, native endianness, every field written on its own (no struct padding):
+ *    magic[8]  last_seq
+ *    n_stats     { sym_code supply max_supply precision issuer refund_delay
+ *                  transfer_fee_ratio fee_receiver auto_reclaim }
+ *    n_balances  { owner sym_code balance locked unstaking precision }
+ *    n_owners    { owner n_refunds { index available_time amount sym_code } }
+ * Version 02 lacks auto_reclaim and is read with it off, as no symbol could opt in then.
+ * Version 01 wrote raw structs and is rejected, its state is rebuilt from the stream.
+ * Written to '<path>.tmp' and renamed over '<path>' so a crash never leaves a torn file.
+ */
+namespace {
+   constexpr char     checkpoint_v02[2]   = { '0', '2' };
+   constexpr uint64_t stats_record_size   = 8 + 8 + 8 + 1 + 8 + 8 + 8 + 8 + 1;
+   constexpr uint64_t balance_record_size = 8 + 8 + 8 + 8 + 8 + 1;
+   constexpr uint64_t owner_record_size   = 8 + 8;
+   constexpr uint64_t refund_record_size  = 8 + 4 + 8 + 8;
+
+   template<typename T>
+   void write_pod( std::FILE* f, const T& v ) {
+      check( std::fwrite( &v, sizeof(T), 1, f ) == 1, "checkpoint write failed" );
+   }
+
+   template<typename T>
+   void read_pod( std::FILE* f, T& v ) {
+      check( std::fread( &v, sizeof(T), 1, f ) == 1, "checkpoint truncated" );
+   }
+
+   // a count is only trusted if that many records still fit in the file
+   uint64_t read_count( std::FILE* f, uint64_t file_size, uint64_t record_size ) {
+      uint64_t n = 0;
+      read_pod( f, n );
+      long pos = std::ftell( f );
+      check( pos >= 0 && n <= ( file_size - static_cast<uint64_t>( pos ) ) / record_size, "checkpoint corrupted" );
+      return n;
+   }
+}
+
+void state::save( const std::string& path )const
+{
+   std::string tmp = path + ".tmp";
+   std::FILE* f = std::fopen( tmp.c_str(), "wb" );
+   check( f != nullptr, "cannot open checkpoint for writing" );
+
+   try {
+      check( std::fwrite( checkpoint_magic, 1, sizeof(checkpoint_magic), f ) == sizeof(checkpoint_magic), "checkpoint write failed" );
+      write_pod( f, _last_seq );
+
+      write_pod( f, static_cast<uint64_t>( _stats.size() ) );
+      for( const auto& s : _stats ) {
+         write_pod( f, s.first );
+         write_pod( f, s.second.supply );
+         write_pod( f, s.second.max_supply );
+         write_pod( f, s.second.precision );
+         write_pod( f, s.second.issuer );
+         write_pod( f, s.second.refund_delay );
+         write_pod( f, s.second.transfer_fee_ratio );
+         write_pod( f, s.second.fee_receiver );
+         write_pod( f, static_cast<uint8_t>( s.second.auto_reclaim ) );
+      }
+
+      write_pod( f, static_cast<uint64_t>( _balances.size() ) );
+      _balances.for_each( [&]( const balance_store::slot& s ) {
+         write_pod( f, s.owner );
+         write_pod( f, s.sym_code );
+         write_pod( f, s.row.balance );
+         write_pod( f, s.row.locked );
+         write_pod( f, s.row.unstaking );
+         write_pod( f, s.row.precision );
+      });
+
+      write_pod( f, static_cast<uint64_t>( _refunds.size() ) );
+      for( const auto& r : _refunds ) {
+         write_pod( f, r.first );
+         write_pod( f, static_cast<uint64_t>( r.second.size() ) );
+         for( const auto& req : r.second ) {
+            write_pod( f, req.index );
+            write_pod( f, req.available_time );
+            write_pod( f, req.amount );
+            write_pod( f, req.sym_code );
+         }
+      }
+
+      check( std::fflush( f ) == 0 && fsync( fileno( f ) ) == 0, "checkpoint flush failed" );
+   } catch( ... ) {
+      std::fclose( f );
+      std::remove( tmp.c_str() );
+      throw;
+   }
+   std::fclose( f );
+   check( std::rename( tmp.c_str(), path.c_str() ) == 0, "cannot rename checkpoint" );
+}
+
+bool state::load( const std::string& path )
+{
+   std::FILE* f = std::fopen( path.c_str(), "rb" );
+   if( f == nullptr ) return false;
+
+   try {
+      check( std::fseek( f, 0, SEEK_END ) == 0, "cannot read checkpoint" );
+      long end = std::ftell( f );
+      check( end >= 0 && std::fseek( f, 0, SEEK_SET ) == 0, "cannot read checkpoint" );
+      uint64_t file_size = static_cast<uint64_t>( end );
+
+      char magic[sizeof(checkpoint_magic)];
+      check( std::fread( magic, 1, sizeof(magic), f ) == sizeof(magic)
+             && std::equal( magic, magic + checkpoint_tag_size, checkpoint_magic ), "not a checkpoint file" );
+      bool v02 = std::equal( magic + checkpoint_tag_size, magic + sizeof(magic), checkpoint_v02 );
+      if( !v02 && !std::equal( magic + checkpoint_tag_size, magic + sizeof(magic), checkpoint_magic + checkpoint_tag_size ) ) {
+         throw indexer_error( "checkpoint format version " + std::string( magic + checkpoint_tag_size, 2 )
+                              + " is not supported (expected " + std::string( checkpoint_magic + checkpoint_tag_size, 2 )
+                              + "), delete it and rebuild the state by replaying the trace stream from the start" );
+      }
+
+      uint64_t last_seq = 0;
+      read_pod( f, last_seq );
+
+      decltype(_stats) stats;
+      uint64_t n = read_count( f, file_size, v02 ? stats_record_size - 1 : stats_record_size );
+      for( uint64_t i = 0; i < n; ++i ) {
+         uint64_t sym_code;
+         read_pod( f, sym_code );
+         auto& st = stats[sym_code];
+         read_pod( f, st.supply );
+         read_pod( f, st.max_supply );
+         read_pod( f, st.precision );
+         read_pod( f, st.issuer );
+         read_pod( f, st.refund_delay );
+         read_pod( f, st.transfer_fee_ratio );
+         read_pod( f, st.fee_receiver );
+         if( !v02 ) {
+            uint8_t auto_reclaim;
+            read_pod( f, auto_reclaim );
+            st.auto_reclaim = auto_reclaim != 0;
+         }
+      }
+
+      balance_store balances;
+      n = read_count( f, file_size, balance_record_size );
+      for( uint64_t i = 0; i < n; ++i ) {
+         uint64_t owner, sym_code;
+         balance_row row;
+         read_pod( f, owner );
+         read_pod( f, sym_code );
+         read_pod( f, row.balance );
+         read_pod( f, row.locked );
+         read_pod( f, row.unstaking );
+         read_pod( f, row.precision );
+         balances.emplace( owner, sym_code, row.precision ) = row;
+      }
+
+      decltype(_refunds) refunds;
+      n = read_count( f, file_size, owner_record_size );
+      for( uint64_t i = 0; i < n; ++i ) {
+         uint64_t owner;
+         read_pod( f, owner );
+         uint64_t count = read_count( f, file_size, refund_record_size );
+         auto& reqs = refunds[owner];
+         reqs.resize( count );
+         for( auto& req : reqs ) {
+            read_pod( f, req.index );
+            read_pod( f, req.available_time );
+            read_pod( f, req.amount );
+            read_pod( f, req.sym_code );
+         }
+      }
+
+      _last_seq = last_seq;
+      _stats.swap( stats );
+      std::swap( _balances, balances );
+      _refunds.swap( refunds );
+   } catch( ... ) {
+      std::fclose( f );
+      throw;
+   }
+   std::fclose( f );
+   return true;
+}
+
+} /// namespace stake_indexer
@@ -0,0 +1,180 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+#include <stdexcept>
+
+/*
+ * Native indexer for the stake-token contract.
+ *
+ * Consumes the flattened, already executed action traces of the contract
+ * (inline and deferred actions included, in execution order) and replays
+ * their effect on an in-memory copy of the 'accounts', 'lockaccounts',
+ * 'refunds' and 'stat' tables. Nothing is re-validated against the chain:
+ * a failed check means the stream has a gap or is out of order.
+ */
+namespace stake_indexer {
+
+   struct indexer_error : public std::runtime_error {
+      using std::runtime_error::runtime_error;
+   };
+
+   inline void check( bool pred, const char* msg ) {
+      if( !pred ) throw indexer_error( msg );
+   }
+
+   // same encoding as eosio::name
+   constexpr uint64_t char_to_name_value( char c ) {
+      if( c >= 'a' && c <= 'z' ) return ( c - 'a' ) + 6;
+      if( c >= '1' && c <= '5' ) return ( c - '1' ) + 1;
+      return 0;
+   }
+
+   constexpr uint64_t string_to_name( std::string_view str ) {
+      uint64_t value = 0;
+      for( size_t i = 0; i < str.size() && i < 13; ++i ) {
+         uint64_t c = char_to_name_value( str[i] );
+         if( i < 12 ) {
+            c &= 0x1f;
+            c <<= 64 - 5 * ( i + 1 );
+         } else {
+            c &= 0x0f;
+         }
+         value |= c;
+      }
+      return value;
+   }
+
+   std::string name_to_string( uint64_t value );
+   uint64_t    string_to_symbol_code( std::string_view str );
+   std::string symbol_code_to_string( uint64_t value );
+
+   struct asset {
+      int64_t  amount    = 0;
+      uint64_t sym_code  = 0;
+      uint8_t  precision = 0;
+   };
+
+   // "100.0000 ADD"
+   asset       string_to_asset( std::string_view str );
+   std::string asset_to_string( int64_t amount, uint64_t sym_code, uint8_t precision );
+
+   // one row of 'accounts' joined with 'lockaccounts', plus the sum of pending refunds
+   struct balance_row {
+      int64_t  balance   = 0;   // accounts.balance, liquid + locked
+      int64_t  locked    = 0;   // lockaccounts.locked_balance, staked + unstaking
+      int64_t  unstaking = 0;   // sum of refund requests of this symbol
+      uint8_t  precision = 0;
+
+      int64_t liquid()const { return balance - locked; }
+      int64_t staked()const { return locked - unstaking; }
+   };
+
+   /*
+    * Open addressing table keyed by (owner, sym_code), rows stored inline so
+    * a lookup touches one or two cache lines. Linear probing with backward
+    * shift deletion, no tombstones.
+    */
+   class balance_store {
+      public:
+         struct slot {
+            uint64_t    owner    = 0;
+            uint64_t    sym_code = 0;   // 0 marks an empty slot, valid codes are never 0
+            balance_row row;
+         };
+
+         balance_store();
+
+         const balance_row* find( uint64_t owner, uint64_t sym_code )const;
+         balance_row*       find( uint64_t owner, uint64_t sym_code );
+         balance_row&       emplace( uint64_t owner, uint64_t sym_code, uint8_t precision );
+         bool               erase( uint64_t owner, uint64_t sym_code );
+
+         size_t size()const { return _size; }
+         void   clear();
+
+         template<typename F>
+         void for_each( F&& f )const {
+            for( const auto& s : _slots ) {
+               if( s.sym_code != 0 ) f( s );
+            }
+         }
+
+      private:
+         size_t bucket( uint64_t owner, uint64_t sym_code )const;
+         void   grow();
+
+         std::vector<slot> _slots;
+         size_t            _mask = 0;
+         size_t            _size = 0;
+   };
+
+   struct currency_stats {
+      int64_t  supply             = 0;
+      int64_t  max_supply         = 0;
+      uint8_t  precision          = 0;
+      uint64_t issuer             = 0;
+      uint64_t refund_delay       = 0;
+      uint64_t transfer_fee_ratio = 0;
+      uint64_t fee_receiver       = 0;
+      bool     auto_reclaim       = false;   // 'reclaim' row present
+   };
+
+   struct refund_request {
+      uint64_t index;
+      uint32_t available_time;   // seconds since epoch
+      int64_t  amount;
+      uint64_t sym_code;
+   };
+
+   class state {
+      public:
+         // applies one trace line, returns false for blank, comment or already applied lines
+         bool apply_line( std::string_view line );
+
+         const balance_row*                 get_balance( uint64_t owner, uint64_t sym_code )const;
+         const currency_stats*              get_stats( uint64_t sym_code )const;
+         const std::vector<refund_request>* get_refunds( uint64_t owner )const;
+
+         const balance_store& balances()const { return _balances; }
+         uint64_t last_sequence()const { return _last_seq; }
+
+         void save( const std::string& path )const;
+         bool load( const std::string& path );
+
+      private:
+         void create( uint64_t issuer, const asset& maximum_supply );
+         void issue( const asset& quantity );
+         void retire( const asset& quantity );
+         void setdelay( uint64_t sym_code, uint64_t t );
+         void settransfee( uint64_t sym_code, uint64_t r, uint64_t receiver );
+         void setreclaim( uint64_t sym_code, bool enabled );
+         void transfer( uint64_t from, uint64_t to, const asset& quantity, std::string_view memo );
+         void stake( uint64_t owner, const asset& quantity );
+         void unstake( uint64_t owner, const asset& quantity, uint32_t block_time );
+         void refund( uint64_t owner, uint64_t index );
+         void cancelunstake( uint64_t owner, uint64_t index );
+         void open( uint64_t owner, uint64_t sym_code, uint8_t precision );
+         void close( uint64_t owner, uint64_t sym_code );
+         void gc( uint64_t sym_code, std::string_view owners );
+
+         void transfer_staked_to_liquid( uint64_t from, uint64_t to, const asset& quantity );
+         void sub_balance( uint64_t owner, const asset& value, bool use_locked_balance = false );
+         void add_balance( uint64_t owner, const asset& value );
+         void erase_empty_rows( uint64_t owner, uint64_t sym_code );
+         currency_stats& get_stats_mutable( uint64_t sym_code );
+
+         balance_store                                                _balances;
+         std::unordered_map<uint64_t, currency_stats>                 _stats;
+         std::unordered_map<uint64_t, std::vector<refund_request>>    _refunds;   // sorted by index
+         uint64_t                                                     _last_seq = 0;
+   };
+
+} /// namespace stake_indexer
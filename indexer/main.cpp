@@ -0,0 +1,156 @@
+/**
+ *  @file
+ *  @copyright defined in eos/LICENSE.txt
+ */
+
+#include "indexer.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+using namespace stake_indexer;
+
+static void usage( const char* prog )
+{
+   std::fprintf( stderr,
+      "usage: %s [options] [trace_file]\n"
+      "  reads action traces from trace_file, or stdin if omitted or '-'\n"
+      "  --checkpoint <file>     load state from and periodically save it to file\n"
+      "  --interval <n>          save a checkpoint every n applied actions (default 1000000)\n"
+      "  --query <owner>,<SYM>   print liquid, staked and unstaking balance after catch-up\n"
+      "  --dump                  print every balance row after catch-up\n", prog );
+}
+
+static void print_row( uint64_t owner, uint64_t sym_code, const balance_row& r )
+{
+   std::printf( "%s\t%s\t%s\t%s\n", name_to_string( owner ).c_str(),
+                asset_to_string( r.liquid(), sym_code, r.precision ).c_str(),
+                asset_to_string( r.staked(), sym_code, r.precision ).c_str(),
+                asset_to_string( r.unstaking, sym_code, r.precision ).c_str() );
+}
+
+int main( int argc, char** argv )
+{
+   std::string checkpoint;
+   std::string input = "-";
+   uint64_t    interval = 1000000;
+   bool        dump = false;
+   std::vector<std::string> queries;
+
+   for( int i = 1; i < argc; ++i ) {
+      auto has_value = [&]() { return i + 1 < argc; };
+      if( !std::strcmp( argv[i], "--checkpoint" ) && has_value() ) {
+         checkpoint = argv[++i];
+      } else if( !std::strcmp( argv[i], "--interval" ) && has_value() ) {
+         interval = std::strtoull( argv[++i], nullptr, 10 );
+      } else if( !std::strcmp( argv[i], "--query" ) && has_value() ) {
+         queries.emplace_back( argv[++i] );
+      } else if( !std::strcmp( argv[i], "--dump" ) ) {
+         dump = true;
+      } else if( argv[i][0] == '-' && argv[i][1] != '\0' ) {
+         usage( argv[0] );
+         return 1;
+      } else {
+         input = argv[i];
+      }
+   }
+
+   state st;
+   try {
+      if( !checkpoint.empty() && st.load( checkpoint ) ) {
+         std::fprintf( stderr, "loaded checkpoint at sequence %llu, %zu balance rows\n",
+                       static_cast<unsigned long long>( st.last_sequence() ), st.balances().size() );
+      }
+   } catch( const indexer_error& e ) {
+      std::fprintf( stderr, "%s: %s\n", checkpoint.c_str(), e.what() );
+      return 1;
+   }
+
+   std::FILE* in = ( input == "-" ) ? stdin : std::fopen( input.c_str(), "rb" );
+   if( in == nullptr ) {
+      std::fprintf( stderr, "cannot open %s\n", input.c_str() );
+      return 1;
+   }
+   static char inbuf[1 << 20];
+   std::setvbuf( in, inbuf, _IOFBF, sizeof(inbuf) );
+
+   auto save = [&]() {
+      try {
+         st.save( checkpoint );
+         return true;
+      } catch( const indexer_error& e ) {
+         std::fprintf( stderr, "%s: %s\n", checkpoint.c_str(), e.what() );
+         return false;
+      }
+   };
+
+   uint64_t applied = 0;
+   uint64_t since_checkpoint = 0;
+   uint64_t line_no = 0;
+   auto start = std::chrono::steady_clock::now();
+
+   char*  line = nullptr;
+   size_t cap = 0;
+   ssize_t len;
+   int rc = 0;
+   while( ( len = getline( &line, &cap, in ) ) != -1 ) {
+      ++line_no;
+      if( len > 0 && line[len - 1] == '\n' ) --len;
+      try {
+         if( !st.apply_line( std::string_view( line, len ) ) ) continue;
+      } catch( const indexer_error& e ) {
+         std::fprintf( stderr, "line %llu: %s\n", static_cast<unsigned long long>( line_no ), e.what() );
+         rc = 1;
+         break;
+      }
+      ++applied;
+      if( !checkpoint.empty() && interval > 0 && ++since_checkpoint >= interval ) {
+         if( !save() ) {
+            rc = 1;
+            break;
+         }
+         since_checkpoint = 0;
+      }
+   }
+   std::free( line );
+   if( in != stdin ) std::fclose( in );
+
+   // on a bad line the state may be half applied, keep the last good checkpoint
+   if( rc == 0 && !checkpoint.empty() && since_checkpoint > 0 && !save() ) rc = 1;
+
+   double secs = std::chrono::duration<double>( std::chrono::steady_clock::now() - start ).count();
+   std::fprintf( stderr, "applied %llu actions in %.3fs (%.0f actions/s), last sequence %llu\n",
+                 static_cast<unsigned long long>( applied ), secs, secs > 0 ? applied / secs : 0.0,
+                 static_cast<unsigned long long>( st.last_sequence() ) );
+
+   for( const auto& q : queries ) {
+      auto comma = q.find( ',' );
+      if( comma == std::string::npos ) {
+         std::fprintf( stderr, "bad query '%s', expected owner,SYM\n", q.c_str() );
+         rc = 1;
+         continue;
+      }
+      try {
+         uint64_t owner = string_to_name( std::string_view( q ).substr( 0, comma ) );
+         uint64_t sym_code = string_to_symbol_code( std::string_view( q ).substr( comma + 1 ) );
+         if( const auto* r = st.get_balance( owner, sym_code ) ) {
+            print_row( owner, sym_code, *r );
+         } else {
+            std::printf( "%s\tnot found\n", q.c_str() );
+         }
+      } catch( const indexer_error& e ) {
+         std::fprintf( stderr, "bad query '%s': %s\n", q.c_str(), e.what() );
+         rc = 1;
+      }
+   }
+
+   if( dump ) {
+      st.balances().for_each( [&]( const balance_store::slot& s ) {
+         print_row( s.owner, s.sym_code, s.row );
+      });
+   }
+
+   return rc;
+}
@@ -1,2 +1,4 @@
+set -e
 eosio-cpp token/token.cpp -o token/token.wasm --abigen --contract=token
+g++ -std=c++17 -O2 indexer/indexer.cpp indexer/main.cpp -o indexer/stake-indexer
 
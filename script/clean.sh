@@ -1,3 +1,4 @@
 rm -f token/*.wasm
 rm -f token/*.wast
-rm -f token/*.abi
\ No newline at end of file
+rm -f token/*.abi
+rm -f indexer/stake-indexer
\ No newline at end of file
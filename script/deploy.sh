@@ -1,3 +1,5 @@
+# rebuild so token.wasm and the --abigen token.abi always match the sources
+bash script/build.sh || exit 1
 cleos wallet unlock -n jungle --password $JunlgePassWD
 alias kcleos="cleos -u https://api-kylin.eoslaomao.com"
 kcleos set contract  hellomykey11 token/
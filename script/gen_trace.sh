@@ -0,0 +1,43 @@
+# synthetic trace for the indexer: gen_trace.sh <accounts> <rounds> [reclaim] > big.trace
+# every round each account sends 1 token to a neighbour, every 4th account
+# stakes, unstakes and is refunded, and a batch of scratch rows is opened
+# and closed again to exercise row deletion; with reclaim=1 the symbol opts
+# in and the scratch rows are funded and drained instead, so they are erased
+# automatically and the sweep over the next batch goes through gc
+awk -v N="${1:-100000}" -v R="${2:-10}" -v RECLAIM="${3:-0}" '
+function nm(prefix, i,    s, k) {
+   s = ""
+   for( k = 0; k < 8; k++ ) { s = s substr("abcdefghijklmnopqrstuvwxyz", i % 26 + 1, 1); i = int(i / 26) }
+   return prefix s
+}
+function out(line) { print seq++ "\t" t "\t" line }
+BEGIN {
+   if( R >= N || R > 18 ) { print "need rounds < accounts and rounds <= 18" > "/dev/stderr"; exit 1 }
+   seq = 1; t = 1546300800
+   out("create\tissuer\t100000000000.0000 ADD")
+   out("issue\tissuer\t100000000000.0000 ADD\t")
+   if( RECLAIM ) out("setreclaim\t4,ADD\t1")
+   for( i = 0; i < N; i++ ) out("transfer\tissuer\t" nm("u", i) "\t100.0000 ADD\t")
+   for( r = 0; r < R; r++ ) {
+      t++
+      for( i = 0; i < N; i++ ) out("transfer\t" nm("u", i) "\t" nm("u", (i + r + 1) % N) "\t1.0000 ADD\tround")
+      for( i = 0; i < N; i += 4 ) {
+         out("stake\t" nm("u", i) "\t10.0000 ADD")
+         out("unstake\t" nm("u", i) "\t5.0000 ADD")
+         out("autorefund\t" nm("u", i) "\t0")
+      }
+      if( RECLAIM ) {
+         for( i = 0; i < N / 10; i++ ) out("transfer\tissuer\t" nm("s", i) "\t1.0000 ADD\t")
+         for( i = N / 10 - 1; i >= 0; i-- ) out("transfer\t" nm("s", i) "\tissuer\t1.0000 ADD\tdrain")
+         for( i = 0; i < N / 10; i++ ) out("open\t" nm("g", i) "\t4,ADD\tissuer")
+         for( i = 0; i < N / 10; i += 100 ) {
+            line = "gc\t4,ADD\t" nm("g", i)
+            for( k = i + 1; k < i + 100 && k < N / 10; k++ ) line = line "," nm("g", k)
+            out(line)
+         }
+      } else {
+         for( i = 0; i < N / 10; i++ ) out("open\t" nm("s", i) "\t4,ADD\tissuer")
+         for( i = N / 10 - 1; i >= 0; i-- ) out("close\t" nm("s", i) "\t4,ADD")
+      }
+   }
+}'
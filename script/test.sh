@@ -9,6 +9,11 @@ get_token_balance() {
     curl_balance '{ "code":"hellomykey11", "symbol":"ADD", "account":"hellomykey14"}'
 }
 
+get_rows() {
+    kcleos get table hellomykey11 $1 accounts
+    kcleos get table hellomykey11 $1 lockaccounts
+}
+
 # # create & issue token
 # kcleos push action hellomykey11 create '{"issuer":"hellomykey12", "maximum_supply":"1000000.0000 ADD"}'  -p hellomykey11
 # kcleos push action hellomykey11 issue '{"to":"hellomykey12", "quantity":"10000.0000 ADD", "memo":""}' -p hellomykey12
@@ -42,6 +47,19 @@ get_token_balance() {
 # get_token_balance
 
 
+# # RAM reclamation, hellomykey14 starts without ADD balance
+# kcleos push action hellomykey11 open '{"owner":"hellomykey14", "symbol":"4,ADD", "ram_payer":"hellomykey14"}' -p hellomykey14
+# kcleos push action hellomykey11 gc '{"symbol":"4,ADD", "owners":["hellomykey14"]}' -p hellomykey12     # fails, symbol has not opted in
+# kcleos push action hellomykey11 setreclaim '{"symbol":"4,ADD", "enabled":true}' -p hellomykey12
+# kcleos push action hellomykey11 gc '{"symbol":"4,ADD", "owners":["hellomykey13", "hellomykey14"]}' -p hellomykey12
+# get_rows hellomykey14     # opened rows are gone, hellomykey13 is kept
+# kcleos push action hellomykey11 transfer '{"from":"hellomykey12", "to":"hellomykey14", "quantity":"10.0000 ADD", "memo":"test"}' -p hellomykey12
+# get_rows hellomykey14     # rows are back
+# kcleos push action hellomykey11 transfer '{"from":"hellomykey14", "to":"hellomykey12", "quantity":"10.0000 ADD", "memo":"test"}' -p hellomykey14
+# get_rows hellomykey14     # drained, rows are gone again
+# kcleos push action hellomykey11 setreclaim '{"symbol":"4,ADD", "enabled":false}' -p hellomykey12
+
+
 # transfer from staked to liquid
 kcleos push action hellomykey11 transfer '{"from":"hellomykey12", "to":"hellomykey13", "quantity":"110.0000 ADD", "memo":"Transfer:FromLiquidToStaked"}' -p hellomykey12
 kcleos push action hellomykey11 transfer '{"from":"hellomykey13", "to":"hellomykey14", "quantity":"100.0000 ADD", "memo":"Transfer:FromStakedToLiquid"}' -p hellomykey13
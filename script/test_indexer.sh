@@ -0,0 +1,46 @@
+set -e
+cd "$(dirname "$0")/.."
+
+g++ -std=c++17 -O2 indexer/indexer.cpp indexer/main.cpp -o indexer/stake-indexer
+tmp=$(mktemp -d)
+trap 'rm -rf "$tmp"' EXIT
+
+# sample trace: staked -> liquid with fee, unstake / refund / cancelunstake, open / close
+indexer/stake-indexer --dump indexer/test/sample.trace | LC_ALL=C sort > "$tmp/sample.out"
+diff -u indexer/test/sample.expected "$tmp/sample.out"
+
+# restart from a checkpoint taken with refunds still pending
+head -n 13 indexer/test/sample.trace | indexer/stake-indexer --checkpoint "$tmp/cp" --interval 2
+indexer/stake-indexer --checkpoint "$tmp/cp" --dump indexer/test/sample.trace | LC_ALL=C sort > "$tmp/restart.out"
+diff -u indexer/test/sample.expected "$tmp/restart.out"
+
+# restart right after setreclaim, the drain that follows must still erase dave's row
+head -n 26 indexer/test/sample.trace | indexer/stake-indexer --checkpoint "$tmp/cp3"
+head -n 27 indexer/test/sample.trace | indexer/stake-indexer --checkpoint "$tmp/cp3" --query dave,ADD > "$tmp/drained.out"
+grep -q "not found" "$tmp/drained.out"
+indexer/stake-indexer --checkpoint "$tmp/cp3" --dump indexer/test/sample.trace | LC_ALL=C sort > "$tmp/reclaim.out"
+diff -u indexer/test/sample.expected "$tmp/reclaim.out"
+
+# gc on a symbol that never opted in is rejected
+if indexer/stake-indexer indexer/test/reclaim_not_opted.trace 2> "$tmp/gc.err"; then exit 1; fi
+grep -q "has not opted in" "$tmp/gc.err"
+
+# synthetic stream: one pass must equal two passes joined by a checkpoint
+bash script/gen_trace.sh 200000 10 > "$tmp/big.trace"
+indexer/stake-indexer --dump "$tmp/big.trace" | LC_ALL=C sort > "$tmp/big.out"
+lines=$(wc -l < "$tmp/big.trace")
+head -n $(( lines / 2 )) "$tmp/big.trace" | indexer/stake-indexer --checkpoint "$tmp/cp2"
+indexer/stake-indexer --checkpoint "$tmp/cp2" --dump "$tmp/big.trace" | LC_ALL=C sort > "$tmp/big2.out"
+diff -q "$tmp/big.out" "$tmp/big2.out"
+test "$(wc -l < "$tmp/big.out")" -eq 200001
+
+# same stream with reclamation on: drained and gc'ed scratch rows must all be gone
+bash script/gen_trace.sh 200000 10 1 > "$tmp/big.trace"
+indexer/stake-indexer --dump "$tmp/big.trace" | LC_ALL=C sort > "$tmp/big.out"
+lines=$(wc -l < "$tmp/big.trace")
+head -n $(( lines / 2 )) "$tmp/big.trace" | indexer/stake-indexer --checkpoint "$tmp/cp4"
+indexer/stake-indexer --checkpoint "$tmp/cp4" --dump "$tmp/big.trace" | LC_ALL=C sort > "$tmp/big2.out"
+diff -q "$tmp/big.out" "$tmp/big2.out"
+test "$(wc -l < "$tmp/big.out")" -eq 200001
+
+echo "done"
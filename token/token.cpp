@@ -6,6 +6,7 @@
 #include "token.hpp"
 
 #define SENDER_ID(X, Y)        ( ((uint128_t)X << 64) | Y )
+#define GC_BATCH_LIMIT         100
 
 time_point current_time_point() {
    const static time_point ct{ microseconds{ static_cast<int64_t>( current_time() ) } };
@@ -302,14 +303,11 @@ void token::unstake(name owner, asset quantity)
 asset token::collect_refund(name owner, const symbol& symbol, uint64_t auto_index)
 {
    refunds_table refunds_tbl( _self, owner.value );
-   //iterate to add up all refund requests
+   //iterate existing rows only, indexes freed by refund/cancelunstake are skipped
    asset unstaking_amount = asset{0, symbol};
-   for (uint64_t i = 0; i < auto_index; i++) {
-        auto req = refunds_tbl.find(i);
-        if (req != refunds_tbl.end()) {
-           if (req->amount.symbol.code().raw() == symbol.code().raw()) {
-               unstaking_amount += req->amount;
-           }
+   for (auto req = refunds_tbl.begin(); req != refunds_tbl.end() && req->index < auto_index; ++req) {
+        if (req->amount.symbol.code().raw() == symbol.code().raw()) {
+            unstaking_amount += req->amount;
         }
    }
    return unstaking_amount;
@@ -378,6 +376,11 @@ void token::sub_balance( name owner, asset value , bool use_locked_balance)
    from_acnts.modify( from, owner, [&]( auto& a ) {
          a.balance -= value;
    });
+
+   if( from.balance.amount == 0 && lock_from.locked_balance.amount == 0 && is_auto_reclaim( value.symbol.code().raw() ) ) {
+      from_acnts.erase( from );
+      lock_from_acnts.erase( lock_from );
+   }
 }
 
 void token::add_balance( name owner, asset value, name ram_payer )
@@ -449,6 +452,41 @@ void token::close( name owner, const symbol& symbol )
 
 }
 
+void token::gc( const symbol& symbol, const std::vector<name>& owners )
+{
+   auto sym_code_raw = symbol.code().raw();
+
+   stats statstable( _self, sym_code_raw );
+   const auto& st = statstable.get( sym_code_raw, "symbol does not exist." );
+   check( st.supply.symbol == symbol, "symbol precision mismatch." );
+
+   require_auth( st.issuer );
+   check( is_auto_reclaim( sym_code_raw ), "symbol has not opted in to reclaim, call setreclaim first." );
+   check( owners.size() <= GC_BATCH_LIMIT, "too many owners in one gc batch" );
+
+   for( const auto& owner : owners ) {
+      erase_empty_rows( owner, sym_code_raw );
+   }
+}
+
+/*
+ * Erase both balance rows of an account whose balance and locked balance are zero.
+ * Pending refunds keep the locked balance above zero, so no refund row is orphaned.
+ */
+void token::erase_empty_rows(name owner, uint64_t sym_code_raw)
+{
+   accounts acnts( _self, owner.value );
+   auto it = acnts.find( sym_code_raw );
+   if( it != acnts.end() && it->balance.amount != 0 ) return;
+
+   lock_accounts lock_acnts( _self, owner.value );
+   auto lock_it = lock_acnts.find( sym_code_raw );
+   if( lock_it != lock_acnts.end() && lock_it->locked_balance.amount != 0 ) return;
+
+   if( it != acnts.end() ) acnts.erase( it );
+   if( lock_it != lock_acnts.end() ) lock_acnts.erase( lock_it );
+}
+
 void token::setdelay(const symbol& symbol, uint64_t t)
 {
    auto sym_code_raw = symbol.code().raw();
@@ -481,6 +519,27 @@ void token::settransfee(const symbol& symbol, uint64_t r, name receiver)
    });
 }
 
+void token::setreclaim(const symbol& symbol, bool enabled)
+{
+   auto sym_code_raw = symbol.code().raw();
+
+   stats statstable( _self, sym_code_raw );
+   const auto& st = statstable.get( sym_code_raw, "symbol does not exist." );
+   check( st.supply.symbol == symbol, "symbol precision mismatch." );
+
+   require_auth( st.issuer );
+
+   reclaim_table reclaim_tbl( _self, _self.value );
+   auto item = reclaim_tbl.find( sym_code_raw );
+   if( enabled && item == reclaim_tbl.end() ) {
+      reclaim_tbl.emplace( st.issuer, [&](auto& i) {
+         i.sym_code = symbol.code();
+      });
+   } else if( !enabled && item != reclaim_tbl.end() ) {
+      reclaim_tbl.erase( item );
+   }
+}
+
 void token::addblacklist(const symbol& symbol, name account)
 {
    auto sym_code_raw = symbol.code().raw();
@@ -524,4 +583,10 @@ void token::check_blacklist(uint64_t sym_code_raw, name account)
    check(item == blacklist_tbl.end(), "account is blacklisted.");
 }
 
-EOSIO_DISPATCH( token, (create)(issue)(transfer)(open)(close)(retire)(stake)(unstake)(cancelunstake)(refund)(autorefund)(setdelay)(settransfee)(autostake)(addblacklist)(rmblacklist))
\ No newline at end of file
+bool token::is_auto_reclaim(uint64_t sym_code_raw)
+{
+   reclaim_table reclaim_tbl( _self, _self.value );
+   return reclaim_tbl.find( sym_code_raw ) != reclaim_tbl.end();
+}
+
+EOSIO_DISPATCH( token, (create)(issue)(transfer)(open)(close)(gc)(retire)(stake)(unstake)(cancelunstake)(refund)(autorefund)(setdelay)(settransfee)(setreclaim)(autostake)(addblacklist)(rmblacklist))
\ No newline at end of file
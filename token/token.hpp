@@ -10,6 +10,7 @@
 #include <eosiolib/transaction.hpp>
 
 #include <string>
+#include <vector>
 using namespace eosio;
 using std::string;
 
@@ -34,6 +35,9 @@ class [[eosio::contract]] token : public contract {
       [[eosio::action]]
       void settransfee(const symbol& symbol, uint64_t r, name receiver);
 
+      [[eosio::action]]
+      void setreclaim(const symbol& symbol, bool enabled);
+
       [[eosio::action]]
       void addblacklist(const symbol& symbol, name account);
 
@@ -70,6 +74,9 @@ class [[eosio::contract]] token : public contract {
       [[eosio::action]]
       void close( name owner, const symbol& symbol );
 
+      [[eosio::action]]
+      void gc( const symbol& symbol, const std::vector<name>& owners );
+
       static asset get_supply( name token_contract_account, symbol_code sym_code )
       {
          stats statstable( token_contract_account, sym_code.raw() );
@@ -80,8 +87,12 @@ class [[eosio::contract]] token : public contract {
       static asset get_balance( name token_contract_account, name owner, symbol_code sym_code )
       {
          accounts accountstable( token_contract_account, owner.value );
-         const auto& ac = accountstable.get( sym_code.raw() );
-         return ac.balance;
+         auto ac = accountstable.find( sym_code.raw() );
+         // drained rows are erased when the symbol opted in to reclaim
+         if( ac == accountstable.end() ) {
+            return asset{ 0, get_supply( token_contract_account, sym_code ).symbol };
+         }
+         return ac->balance;
       }
 
    private:
@@ -128,11 +139,20 @@ class [[eosio::contract]] token : public contract {
          uint64_t  primary_key()const { return account.value; }
       };
 
+      // symbols whose balance rows are erased as soon as they become empty
+      // scope: _self
+      struct [[eosio::table]] auto_reclaim {
+         symbol_code sym_code;
+
+         uint64_t  primary_key()const { return sym_code.raw(); }
+      };
+
       typedef eosio::multi_index< name("accounts"), account > accounts;
       typedef eosio::multi_index< name("lockaccounts"), lock_account > lock_accounts;
       typedef eosio::multi_index< name("stat"), currency_stats > stats;
       typedef eosio::multi_index< name("refunds"), refund_request >  refunds_table;
       typedef eosio::multi_index< name("blacklist"), stake_blacklist > blacklist_table;
+      typedef eosio::multi_index< name("reclaim"), auto_reclaim > reclaim_table;
 
       void sub_balance( name owner, asset value , bool use_locked_balance = false);
       void add_balance( name owner, asset value, name ram_payer );
@@ -145,5 +165,7 @@ class [[eosio::contract]] token : public contract {
       void transfer_staked_to_liquid(name from, name to, asset quantity);
       asset collect_refund(name owner, const symbol& symbol, uint64_t auto_index);
       void check_blacklist(uint64_t sym_code_raw, name account);
+      bool is_auto_reclaim(uint64_t sym_code_raw);
+      void erase_empty_rows(name owner, uint64_t sym_code_raw);
 };
 